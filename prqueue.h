@@ -1,12 +1,26 @@
 #pragma once
 
-#include <iostream>  // For debugging
-#include <sstream>   // For as_string
+#include <algorithm>  // For stable_sort
+#include <cstdint>    // For the fingerprint arithmetic
+#include <functional> // For std::hash
+#include <iostream>   // For debugging
+#include <sstream>    // For as_string
+#include <utility>    // For pair
+#include <vector>     // For the insertion buffer
 
 using namespace std;
 
 template <typename T>
 class prqueue {
+   public:
+    /// Counters describing how the insertion buffer has been merged into the
+    /// tree. See `set_buffer_threshold`.
+    struct merge_stats {
+        size_t merges;           // Total number of merges
+        size_t thresholdMerges;  // Merges forced by the buffer filling up
+        size_t mergedValues;     // Values moved from the buffer into the tree
+    };
+
    private:
     struct NODE {
         int priority;
@@ -15,21 +29,129 @@ class prqueue {
         NODE* left;
         NODE* right;
         NODE* link;  // Link to duplicates -- Part 2 only
+
+        // Hash of the duplicate list starting here and the base raised to its
+        // length, see `_listTerm`. Only kept on tree nodes while
+        // fingerprinting is enabled.
+        uint64_t listHash;
+        uint64_t listPow;
     };
 
-    NODE* root;
-    size_t sz;
+    // Merging the insertion buffer reshapes the tree without changing the
+    // queue's contents, which const members such as `peek` need to do.
+    mutable NODE* root;
+    size_t sz;  // Includes buffered values
+
+    // Structural fingerprint of the tree, see `fingerprint`. Sum of one
+    // `_edgeHash` and one `_listTerm` per tree node. Only maintained while
+    // `fingerprinting` is set.
+    bool fingerprinting;
+    mutable uint64_t fp;
+
+    // Unsorted values waiting to be merged into the tree, in enqueue order.
+    mutable vector<pair<int, T>> buffer;
+    size_t bufferThreshold;
+    mutable merge_stats stats;
 
     // Utility pointers for begin and next.
     NODE* curr;
     NODE* temp;  // Optional
 
+    // Finalizer from splitmix64, spreads every input bit over the output
+    static uint64_t _mix(uint64_t x) {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    // Hash of a value, or 0 when `T` has no `std::hash`. Then only the shape
+    // and priorities make it into the fingerprint.
+    static uint64_t _valueHash(const T& value) {
+        if constexpr (requires { std::hash<T>{}(value); }) {
+            return std::hash<T>{}(value);
+        } else {
+            return 0;
+        }
+    }
+
+    // Hash of the edge from a tree node to its parent. `side` is 0 for a left
+    // child, 1 for a right child and 2 for the root. A BST with distinct
+    // priorities is fully described by these edges, and removing the minimum
+    // only ever re-parents a single node.
+    static uint64_t _edgeHash(int priority, const NODE* parent, int side) {
+        uint64_t p = uint32_t(priority);
+        uint64_t q = parent ? uint32_t(parent->priority) : 0;
+        return _mix((p << 32 | q) ^ _mix(side));
+    }
+
+    static uint64_t _edgeHash(const NODE* node) {
+        const NODE* parent = node->parent;
+        int side = !parent ? 2 : parent->left == node ? 0 : 1;
+        return _edgeHash(node->priority, parent, side);
+    }
+
+    // Base of the polynomial duplicate-list hash sum(h_i * BASE^i) and its
+    // inverse mod 2^64, which exists because the base is odd. Removing the
+    // front of a list is then (hash - h_0) * BASE_INV, in O(1).
+    static constexpr uint64_t BASE = 0x100000001b3ULL;
+    static constexpr uint64_t _inverse(uint64_t x) {
+        uint64_t inv = x;  // Correct to 3 bits, each Newton step doubles that
+        for (int i = 0; i < 5; i++) {
+            inv *= 2 - x * inv;
+        }
+        return inv;
+    }
+    static constexpr uint64_t BASE_INV = _inverse(BASE);
+
+    // Hash of the duplicate list of a tree node with the given list hash
+    static uint64_t _listTerm(int priority, uint64_t listHash) {
+        return _mix(_mix(uint32_t(priority)) ^ listHash);
+    }
+
+    // Adds a tree node holding a single value to the fingerprint
+    void _hashNewNode(NODE* node) const {
+        if (!fingerprinting) return;
+        node->listHash = _mix(_valueHash(node->value));
+        node->listPow = BASE;
+        fp += _edgeHash(node) + _listTerm(node->priority, node->listHash);
+    }
+
+    // Adds a value appended to the duplicate list of the tree node `head`
+    void _hashAppend(NODE* head, const T& value) const {
+        if (!fingerprinting) return;
+        fp -= _listTerm(head->priority, head->listHash);
+        head->listHash += _mix(_valueHash(value)) * head->listPow;
+        head->listPow *= BASE;
+        fp += _listTerm(head->priority, head->listHash);
+    }
+
+    // Computes the fingerprint of a subtree from scratch. If `store` is set,
+    // also records the list hashes on the tree nodes.
+    uint64_t _hashTree(NODE* node, bool store) const {
+        if (!node) return 0;
+
+        uint64_t listHash = 0;
+        uint64_t listPow = 1;
+        for (NODE* dup = node; dup != nullptr; dup = dup->link) {
+            listHash += _mix(_valueHash(dup->value)) * listPow;
+            listPow *= BASE;
+        }
+        if (store) {
+            node->listHash = listHash;
+            node->listPow = listPow;
+        }
+
+        return _edgeHash(node) + _listTerm(node->priority, listHash) +
+               _hashTree(node->left, store) + _hashTree(node->right, store);
+    }
+
     // Clones a given tree, used in copy constructor and assignment operator
     NODE* _clone(NODE* node, NODE* parent = nullptr) {
         if (!node) return nullptr; 
 
         // Create a new node with the same value and priority
-        NODE* newNode = new NODE{node->priority, node->value, parent, nullptr, nullptr, nullptr};
+        NODE* newNode = new NODE{node->priority, node->value, parent, nullptr, nullptr, nullptr, node->listHash, node->listPow};
         newNode->left = _clone(node->left, newNode);  // Recursively clone the left subtree
         newNode->right = _clone(node->right, newNode); // Recursively clone the right subtree
 
@@ -51,6 +173,7 @@ class prqueue {
         if (!node) {
             // Insert the new node if the current spot is empty
             node = new NODE{priority, value, parent, nullptr, nullptr, nullptr};
+            _hashNewNode(node);
         } else if (priority < node->priority) {
             // If the new node's priority is less, insert it in the left subtree
             _insert(node->left, node, value, priority);
@@ -64,7 +187,183 @@ class prqueue {
                 temp = temp->link;
             }
             temp->link = new NODE{priority, value, parent, nullptr, nullptr, nullptr};
+            _hashAppend(node, temp->link->value);
+        }
+    }
+
+    // Appends the run of buffered values [first, last), which all share the
+    // same priority, to the tree with a single descent.
+    void _insertRun(size_t first, size_t last) const {
+        int priority = buffer[first].first;
+        NODE** slot = &root;
+        NODE* parent = nullptr;
+        while (*slot && (*slot)->priority != priority) {
+            parent = *slot;
+            slot = priority < parent->priority ? &parent->left : &parent->right;
+        }
+
+        NODE* tail;
+        if (!*slot) {
+            *slot = new NODE{priority, std::move(buffer[first].second), parent, nullptr, nullptr, nullptr};
+            tail = *slot;
+            _hashNewNode(tail);
+            first++;
+        } else {
+            tail = *slot;
+            while (tail->link) {
+                tail = tail->link;
+            }
+        }
+
+        // Duplicates go after the ones already in the tree, in enqueue order
+        for (size_t i = first; i < last; i++) {
+            tail->link = new NODE{priority, std::move(buffer[i].second), parent, nullptr, nullptr, nullptr};
+            tail = tail->link;
+            _hashAppend(*slot, tail->value);
+        }
+    }
+
+    // Inserts the priority runs [lo, hi) of the sorted buffer, median run
+    // first, so a sorted batch does not degrade into a linked list.
+    void _insertRuns(const vector<size_t>& runs, size_t lo, size_t hi) const {
+        if (lo >= hi) return;
+
+        size_t mid = lo + (hi - lo) / 2;
+        _insertRun(runs[mid], runs[mid + 1]);
+        _insertRuns(runs, lo, mid);
+        _insertRuns(runs, mid + 1, hi);
+    }
+
+    // Sorts the insertion buffer and merges it into the tree
+    void _flush(bool forced = false) const {
+        if (buffer.empty()) return;
+
+        stable_sort(buffer.begin(), buffer.end(),
+                    [](const pair<int, T>& a, const pair<int, T>& b) { return a.first < b.first; });
+
+        // Start offsets of each run of equal priorities, plus an end marker
+        vector<size_t> runs;
+        for (size_t i = 0; i < buffer.size(); i++) {
+            if (i == 0 || buffer[i].first != buffer[i - 1].first) runs.push_back(i);
+        }
+        runs.push_back(buffer.size());
+
+        _insertRuns(runs, 0, runs.size() - 1);
+
+        stats.merges++;
+        if (forced) stats.thresholdMerges++;
+        stats.mergedValues += buffer.size();
+        buffer.clear();
+    }
+
+    // Returns the in-order successor of the tree node `node`
+    NODE* _successor(NODE* node) const {
+        if (node->right) {
+            node = node->right;
+            while (node->left) {
+                node = node->left;
+            }
+            return node;
+        }
+        while (node->parent && node->parent->right == node) {
+            node = node->parent;
+        }
+        return node->parent;
+    }
+
+    // Removes the leftmost tree node `nodeToRemove`, which holds the smallest
+    // priority, returning its value and priority by reference. Returns the
+    // node holding the next smallest value, which is the new leftmost node,
+    // or nullptr if the tree is now empty.
+    NODE* _removeLeftmost(NODE* nodeToRemove, T& value, int& priority) {
+        NODE* parent = nodeToRemove->parent;
+        NODE* nextMin = nodeToRemove->link ? nodeToRemove->link : parent;
+        if (!nodeToRemove->link && nodeToRemove->right) {
+            nextMin = nodeToRemove->right;
+            while (nextMin->left) {
+                nextMin = nextMin->left;
+            }
+        }
+
+        value = nodeToRemove->value;
+        priority = nodeToRemove->priority;
+
+        if (nodeToRemove->link) {
+            if (fingerprinting) {
+                // The next duplicate becomes the head of a list one shorter
+                NODE* next = nodeToRemove->link;
+                fp -= _listTerm(priority, nodeToRemove->listHash);
+                next->listHash = (nodeToRemove->listHash - _mix(_valueHash(value))) * BASE_INV;
+                next->listPow = nodeToRemove->listPow * BASE_INV;
+                fp += _listTerm(priority, next->listHash);
+            }
+
+            // Handle duplicates
+            NODE* linkedNode = nodeToRemove->link;
+            linkedNode->left = nodeToRemove->left;
+            linkedNode->right = nodeToRemove->right;
+            if (linkedNode->left) linkedNode->left->parent = linkedNode;
+            if (linkedNode->right) linkedNode->right->parent = linkedNode;
+            
+            if (parent) {
+                if (parent->left == nodeToRemove) {
+                    parent->left = linkedNode;
+                } else {
+                    parent->right = linkedNode;
+                }
+            } else {
+                root = linkedNode;  // Update the root
+            }
+            linkedNode->parent = parent;
+        } else {
+            if (fingerprinting) {
+                // The right child, if any, takes this node's place under `parent`
+                fp -= _edgeHash(nodeToRemove) + _listTerm(priority, nodeToRemove->listHash);
+                if (nodeToRemove->right) {
+                    fp -= _edgeHash(nodeToRemove->right);
+                    fp += _edgeHash(nodeToRemove->right->priority, parent, parent ? 0 : 2);
+                }
+            }
+
+            // Standard BST removal
+            NODE* replacementNode = nullptr;
+            if (nodeToRemove->left && nodeToRemove->right) {
+                // Node with two children
+                replacementNode = nodeToRemove->right;
+                NODE* successorParent = nodeToRemove;
+                while (replacementNode->left) {
+                    successorParent = replacementNode;
+                    replacementNode = replacementNode->left;
+                }
+                if (successorParent != nodeToRemove) {
+                    successorParent->left = replacementNode->right;
+                    if (replacementNode->right) replacementNode->right->parent = successorParent;
+                    replacementNode->right = nodeToRemove->right;
+                    nodeToRemove->right->parent = replacementNode;
+                }
+                replacementNode->left = nodeToRemove->left;
+                nodeToRemove->left->parent = replacementNode;
+            } else if (nodeToRemove->left || nodeToRemove->right) {
+                // Node with one child
+                replacementNode = nodeToRemove->left ? nodeToRemove->left : nodeToRemove->right;
+                replacementNode->parent = parent;
+            }
+
+            if (parent) {
+                if (parent->left == nodeToRemove) {
+                    parent->left = replacementNode;
+                } else {
+                    parent->right = replacementNode;
+                }
+            } else {
+                root = replacementNode;
+                if (root) root->parent = nullptr;  // New root should have no parent
+            }
         }
+
+        delete nodeToRemove;
+        sz--;
+        return nextMin;
     }
 
     // Performs an in-order traversal of the tree and builds a string representation
@@ -119,6 +418,10 @@ class prqueue {
     prqueue() {
         root = nullptr;
         sz = 0;
+        fingerprinting = false;
+        fp = 0;
+        bufferThreshold = 0;
+        stats = merge_stats{0, 0, 0};
         curr = nullptr;
         temp = nullptr;
     }
@@ -133,7 +436,14 @@ class prqueue {
         
         root = nullptr;  
         sz = other.sz;   
+        bufferThreshold = other.bufferThreshold;
+        stats = merge_stats{0, 0, 0};
+        curr = nullptr;
+        temp = nullptr;
 
+        other._flush();
+        fingerprinting = other.fingerprinting;
+        fp = other.fp;
         if (other.root != nullptr) {
             root = _clone(other.root);
         }
@@ -151,8 +461,12 @@ class prqueue {
         
         if (this != &other) { // Handle self-assignment
             clear(); // Clear existing content
+            other._flush();
             root = _clone(other.root); // Deep copy
+            fingerprinting = other.fingerprinting;
+            fp = other.fp;
             sz = other.sz;
+            bufferThreshold = other.bufferThreshold;
         }
         return *this;
     }
@@ -164,7 +478,11 @@ class prqueue {
         
         _clear(root);
         root = nullptr;
+        buffer.clear();
+        fp = 0;
         sz = 0;
+        curr = nullptr;
+        temp = nullptr;
     }
 
     /// Destructor, cleans up all memory associated with `prqueue`.
@@ -181,14 +499,71 @@ class prqueue {
     /// Uses the priority to determine the location in the underlying tree.
     ///
     /// Runs in O(H + M), where H is the height of the tree, and M is
-    /// the number of duplicate priorities.
+    /// the number of duplicate priorities. When buffering is enabled, runs in
+    /// amortized O(1) until the buffer fills up and is merged.
     void enqueue(T value, int priority) {
         
-        _insert(root, nullptr, value, priority);
         sz++;
+        if (bufferThreshold == 0) {
+            _insert(root, nullptr, value, priority);
+            return;
+        }
+
+        buffer.emplace_back(priority, std::move(value));
+        if (buffer.size() >= bufferThreshold) {
+            _flush(true);
+        }
           
     }
 
+    /// Adds every priority-value pair in `values` to the `prqueue`, moving the
+    /// values out of `values`.
+    ///
+    /// The batch is merged like the insertion buffer, and counts as a merge
+    /// in `get_merge_stats`. It is sorted, and each run of equal priorities
+    /// is inserted with a single descent, median priority first. Sorted
+    /// batches, such as the output of `take_front`, therefore don't degrade
+    /// the tree into a linked list. Equal priorities keep their order within
+    /// the batch.
+    ///
+    /// Runs in O(B log B + B (H + M)), where B is the size of the batch.
+    void enqueue_batch(vector<pair<int, T>>& values) {
+        
+        sz += values.size();
+        for (pair<int, T>& entry : values) {
+            buffer.emplace_back(entry.first, std::move(entry.second));
+        }
+        _flush();
+    }
+
+    /// Enables the insertion buffer for write-heavy bursts.
+    ///
+    /// While enabled, `enqueue` appends to an unsorted buffer instead of
+    /// descending the tree. The buffer is sorted and merged into the tree in
+    /// one pass once it holds `threshold` values, or as soon as `peek`,
+    /// `dequeue`, `begin`, `as_string`, `operator==`, `getRoot` or a copy
+    /// needs ordered access. Because merged values are inserted median
+    /// priority first, the tree structure depends on when merges happen.
+    ///
+    /// A `threshold` of 0 (the default) disables buffering, merging anything
+    /// already buffered.
+    ///
+    /// Runs in O(B log B + B (H + M)), where B is the number of values
+    /// currently buffered, if they have to be merged, and O(1) otherwise.
+    void set_buffer_threshold(size_t threshold) {
+        bufferThreshold = threshold;
+        if (bufferThreshold == 0 || buffer.size() >= bufferThreshold) {
+            _flush(bufferThreshold != 0);
+        }
+    }
+
+    /// Returns how often the insertion buffer has been merged into the tree.
+    ///
+    /// Runs in O(1).
+    merge_stats get_merge_stats() const {
+        return stats;
+    }
+
 
     /// Returns the value with the smallest priority in the `prqueue`, but does
     /// not modify the `prqueue`.
@@ -199,6 +574,7 @@ class prqueue {
     /// the number of duplicate priorities.
     T peek() const {
         
+        _flush();
         if (!root) {
             return T{}; // Return default value for T if the queue is empty.
         }
@@ -218,80 +594,60 @@ class prqueue {
     /// the number of duplicate priorities.
     T dequeue() {
         
+        T value{};
+        int priority;
+        dequeue(value, priority);
+        return value;
+    }
+
+    /// Removes the value with the smallest priority from the `prqueue` and
+    /// returns it and its priority by reference. Returns true if the
+    /// reference parameters were set, and false if the `prqueue` is empty.
+    ///
+    /// Runs in O(H + M), where H is the height of the tree, and M is
+    /// the number of duplicate priorities.
+    bool dequeue(T& value, int& priority) {
+        
+        _flush();
         if (!root) {
-            return T{};  // If the queue is empty, return the default value of T.
+            return false;
         }
 
-        NODE* nodeToRemove = root;
-        NODE* parent = nullptr;
-
         // Find the leftmost node which has the smallest priority.
+        NODE* nodeToRemove = root;
         while (nodeToRemove->left) {
-            parent = nodeToRemove;
             nodeToRemove = nodeToRemove->left;
         }
 
-        T returnValue = nodeToRemove->value;  // Value to return
+        _removeLeftmost(nodeToRemove, value, priority);
+        return true;
 
-        if (nodeToRemove->link) {
-            // Handle duplicates
-            NODE* linkedNode = nodeToRemove->link;
-            linkedNode->left = nodeToRemove->left;
-            linkedNode->right = nodeToRemove->right;
-            if (linkedNode->left) linkedNode->left->parent = linkedNode;
-            if (linkedNode->right) linkedNode->right->parent = linkedNode;
-            
-            if (parent) {
-                if (parent->left == nodeToRemove) {
-                    parent->left = linkedNode;
-                } else {
-                    parent->right = linkedNode;
-                }
-            } else {
-                root = linkedNode;  // Update the root
-            }
-            linkedNode->parent = parent;
-        } else {
-            // Standard BST removal
-            NODE* replacementNode = nullptr;
-            if (nodeToRemove->left && nodeToRemove->right) {
-                // Node with two children
-                replacementNode = nodeToRemove->right;
-                NODE* successorParent = nodeToRemove;
-                while (replacementNode->left) {
-                    successorParent = replacementNode;
-                    replacementNode = replacementNode->left;
-                }
-                if (successorParent != nodeToRemove) {
-                    successorParent->left = replacementNode->right;
-                    if (replacementNode->right) replacementNode->right->parent = successorParent;
-                    replacementNode->right = nodeToRemove->right;
-                    nodeToRemove->right->parent = replacementNode;
-                }
-                replacementNode->left = nodeToRemove->left;
-                nodeToRemove->left->parent = replacementNode;
-            } else if (nodeToRemove->left || nodeToRemove->right) {
-                // Node with one child
-                replacementNode = nodeToRemove->left ? nodeToRemove->left : nodeToRemove->right;
-                replacementNode->parent = parent;
-            }
+    }
 
-            if (parent) {
-                if (parent->left == nodeToRemove) {
-                    parent->left = replacementNode;
-                } else {
-                    parent->right = replacementNode;
-                }
-            } else {
-                root = replacementNode;
-                if (root) root->parent = nullptr;  // New root should have no parent
-            }
+    /// Removes up to `count` values with the smallest priorities from the
+    /// `prqueue`, appending them and their priorities to `out` in the order
+    /// `dequeue` would return them. Returns the number of values removed.
+    ///
+    /// Unlike calling `dequeue` `count` times, walks from each removed node
+    /// to the next instead of descending from the root again.
+    ///
+    /// Runs in O(H + K), where H is the height of the tree, and K is `count`.
+    size_t take_front(size_t count, vector<pair<int, T>>& out) {
+        
+        _flush();
+        NODE* node = root;
+        while (node && node->left) {
+            node = node->left;
         }
 
-        delete nodeToRemove;
-        sz--;
-        return returnValue;
-
+        size_t taken = 0;
+        T value;
+        int priority;
+        for (; taken < count && node; taken++) {
+            node = _removeLeftmost(node, value, priority);
+            out.emplace_back(priority, std::move(value));
+        }
+        return taken;
     }
 
     /// Returns the number of elements in the `prqueue`.
@@ -309,31 +665,12 @@ class prqueue {
     /// O(H), where H is the maximum height of the tree.
     void begin() {
         
-        curr = root; // Starting traversal from the root
-
-        while (curr) {
-            // If no left child, ready to process right subtree
-            if (!curr->left) {
-                temp = curr->right;
-                break;
-            }
-
-            // Locating the in-order predecessor
-            NODE* pNode = curr->left;
-            while (pNode->right && pNode->right != curr) {
-                pNode = pNode->right;
-            }
-
-            // Establishing thread for reverse traversal
-            if (!pNode->right) {
-                pNode->right = curr;
-                curr = curr->left;
-            } else {
-                pNode->right = nullptr;
-                temp = curr->right;
-                break;
-            }
+        _flush();
+        curr = root;
+        while (curr && curr->left) {
+            curr = curr->left;
         }
+        temp = curr;  // Head of the duplicate list being visited
     
     }
 
@@ -357,56 +694,23 @@ class prqueue {
     /// priorities.
     bool next(T& value, int& priority) {
         
-        // When both current and temp are null, traversal is complete
-        if (!curr && !temp) {
+        if (!curr) {
             return false;
         }
 
-        // Process the current node if it's available
-        if (curr) {
-            value = curr->value;
-            priority = curr->priority;
+        value = curr->value;
+        priority = curr->priority;
 
-            // Handle any duplicate nodes
-            if (curr->link) {
-                curr = curr->link;
-            } else {
-                curr = nullptr; // Move to higher priority
-            }
-            return true;
+        // Finish the duplicates before moving to the next priority
+        if (curr->link) {
+            curr = curr->link;
         } else {
-            // Move to the saved node in temp
-            curr = temp;
-
-            while (curr) {
-                // If no left child, ready to process right subtree
-                if (!curr->left) {
-                    temp = curr->right;
-                    break;
-                }
-
-                // Searching for the in-order predecessor again
-                NODE* pNode = curr->left;
-                while (pNode->right && pNode->right != curr) {
-                    pNode = pNode->right;
-                }
-
-                // Reversing the temporary right pointer
-                if (!pNode->right) {
-                    pNode->right = curr;
-                    curr = curr->left;
-                } else {
-                    pNode->right = nullptr;
-                    temp = curr->right;
-                    break;
-                }
-            }
-            return next(value, priority); // Recursive call for the next node
+            curr = _successor(temp);
+            temp = curr;
         }
+        return true;
     }
 
-    
-
     /// Converts the `prqueue` to a string representation, with the values
     /// in-order by priority.
     ///
@@ -433,6 +737,7 @@ class prqueue {
     /// Runs in O(N), where N is the number of values.
     string as_string() const {
         
+        _flush();
         ostringstream oss;
         _inOrderTraversal(root, oss);
         return oss.str();
@@ -473,14 +778,53 @@ class prqueue {
     /// a.enqueue("3", 3);
     /// ```
     ///
+    /// If both `prqueue`s have fingerprinting enabled, queues with different
+    /// fingerprints are rejected in O(1); the trees are only walked when the
+    /// fingerprints match.
+    ///
     /// Runs in O(N) time, where N is the maximum number of nodes in
     /// either `prqueue`.
     ///
     bool operator==(const prqueue& other) const {
         
+        _flush();
+        other._flush();
+        if (sz != other.sz || (fingerprinting && other.fingerprinting && fp != other.fp)) {
+            return false;
+        }
         return _areEqual(root, other.root);
     }
 
+    /// Starts maintaining the fingerprint incrementally, so `fingerprint`
+    /// and `std::hash` run in O(1) and `operator==` can reject unequal queues
+    /// without walking them. Afterwards every `enqueue` and `dequeue` pays
+    /// O(1) extra for hashing. Copies keep fingerprinting enabled.
+    ///
+    /// Runs in O(N), where N is the number of values.
+    void enable_fingerprint() {
+        _flush();
+        if (fingerprinting) return;
+        fingerprinting = true;
+        fp = _hashTree(root, true);
+    }
+
+    /// Returns a hash of the internal tree structure, priorities and values.
+    ///
+    /// Equivalent `prqueue`s (see `operator==`) always have the same
+    /// fingerprint, whether or not fingerprinting is enabled. Values only
+    /// contribute if `std::hash<T>` exists.
+    ///
+    /// Runs in O(1) if fingerprinting is enabled, and O(N) otherwise, where N
+    /// is the number of values. Either way, merges the insertion buffer if it
+    /// is non-empty.
+    size_t fingerprint() const {
+        _flush();
+        if (!fingerprinting) {
+            return size_t(_hashTree(root, false));
+        }
+        return size_t(fp);
+    }
+
     /// Returns a pointer to the root node of the BST.
     ///
     /// Used for testing the internal structure of the BST. Do not edit or
@@ -488,6 +832,18 @@ class prqueue {
     ///
     /// Runs in O(1).
     void* getRoot() {
+        _flush();
         return root;
     }
 };
+
+/// Hashes a `prqueue` by its fingerprint, so queues can key unordered
+/// containers.
+namespace std {
+template <typename T>
+struct hash<prqueue<T>> {
+    size_t operator()(const prqueue<T>& pq) const {
+        return pq.fingerprint();
+    }
+};
+}  // namespace std
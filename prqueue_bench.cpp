@@ -0,0 +1,66 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "prqueue.h"
+#include "prqueue_bptree.h"
+
+using namespace std;
+
+// Times enqueueing `priorities`, building `as_string`, and then dequeueing
+// everything from a fresh queue of type `Q`. `setup` can
+// configure the queue before anything is enqueued.
+template <typename Q>
+void bench(const string& name, const vector<int>& priorities, void (*setup)(Q&) = nullptr) {
+    using clock = chrono::steady_clock;
+    auto ms = [](clock::time_point a, clock::time_point b) {
+        return chrono::duration<double, milli>(b - a).count();
+    };
+
+    Q pq;
+    if (setup) setup(pq);
+    auto t0 = clock::now();
+    for (size_t i = 0; i < priorities.size(); i++) {
+        pq.enqueue(int(i), priorities[i]);
+    }
+    auto t1 = clock::now();
+    size_t len = pq.as_string().size();
+    auto t2 = clock::now();
+    long long sum = 0;
+    while (pq.size() > 0) {
+        sum += pq.dequeue();
+    }
+    auto t3 = clock::now();
+
+    cout << name << ": enqueue " << ms(t0, t1) << " ms, as_string " << ms(t1, t2)
+         << " ms, dequeue " << ms(t2, t3) << " ms (checksum " << sum + len << ")" << endl;
+}
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? strtoul(argv[1], nullptr, 10) : 1000000;
+
+    // Random priorities keep the BST at a reasonable height. A narrow range
+    // of priorities also exercises the duplicate handling of both backends.
+    mt19937 rng(251);
+    vector<int> spread(n);
+    vector<int> narrow(n);
+    uniform_int_distribution<int> wide(0, 1 << 30);
+    uniform_int_distribution<int> few(0, 100000);
+    for (size_t i = 0; i < n; i++) {
+        spread[i] = wide(rng);
+        narrow[i] = few(rng);
+    }
+
+    cout << n << " random priorities" << endl;
+    bench<prqueue<int>>("  bst       ", spread);
+    bench<prqueue<int>>("  bst buf   ", spread, [](prqueue<int>& pq) { pq.set_buffer_threshold(1 << 16); });
+    bench<bpprqueue<int, 16>>("  bptree 16 ", spread);
+    bench<bpprqueue<int, 32>>("  bptree 32 ", spread);
+    bench<bpprqueue<int, 64>>("  bptree 64 ", spread);
+
+    cout << n << " priorities in [0, 100000]" << endl;
+    bench<prqueue<int>>("  bst       ", narrow);
+    bench<bpprqueue<int, 32>>("  bptree 32 ", narrow);
+}
@@ -0,0 +1,491 @@
+#pragma once
+
+#include <iostream>  // For debugging
+#include <sstream>   // For as_string
+#include <utility>   // For std::move
+
+// Key search inside a node is vectorized when the target supports it. Build
+// with `-mavx2` (or `-march=native`) to get the 8-wide path; plain x86-64
+// builds get the 4-wide SSE2 path. Define `PRQUEUE_NO_SIMD` to force the
+// portable scalar loop.
+#if !defined(PRQUEUE_NO_SIMD) && defined(__AVX2__)
+#define PRQUEUE_SIMD_AVX2 1
+#include <immintrin.h>
+#elif !defined(PRQUEUE_NO_SIMD) && defined(__SSE2__)
+#define PRQUEUE_SIMD_SSE2 1
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+/// A priority queue backed by a B+-tree of wide nodes.
+///
+/// Offers the same interface as `prqueue`, but each node holds up to `WIDTH`
+/// priorities in a contiguous array, so a lookup touches one cache line per
+/// level instead of one per priority. All values live in the leaves, which
+/// are chained left to right; iteration, `as_string` and `dequeue` walk that
+/// chain sequentially through memory.
+///
+/// Values with equal priorities come out in the order they were enqueued.
+///
+/// Since values are only ever removed from the front, emptied leaves are
+/// unlinked but nodes are never merged or redistributed.
+template <typename T, int WIDTH = 32>
+class bpprqueue {
+    static_assert(WIDTH >= 4 && WIDTH <= 64, "WIDTH must be between 4 and 64");
+
+   private:
+    struct BNODE {
+        bool isLeaf;
+        int n;  // Number of keys in a leaf, number of children in an inner node
+        int keys[WIDTH];
+    };
+
+    struct LEAF : BNODE {
+        T values[WIDTH];
+        LEAF* next;
+    };
+
+    // keys[i] is the smallest priority that may appear in children[i + 1].
+    struct INNER : BNODE {
+        BNODE* children[WIDTH];
+    };
+
+    BNODE* root;
+    LEAF* head;  // Leftmost leaf, holds the smallest priorities
+    size_t sz;
+
+    // Utility pointers for begin and next.
+    LEAF* curr;
+    int currIdx;
+
+    // Counts how many of the first `n` entries of the sorted array `keys` are
+    // less than or equal to `priority`, i.e. the upper-bound index. Compares a
+    // whole vector of keys per step and counts the matches with a movemask, so a
+    // full node is searched without a branch per key.
+    static int _upperBound(const int* keys, int n, int priority) {
+        int count = 0;
+        int i = 0;
+#if defined(PRQUEUE_SIMD_AVX2)
+        const __m256i needle = _mm256_set1_epi32(priority);
+        for (; i + 8 <= n; i += 8) {
+            __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+            int gt = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(block, needle)));
+            count += 8 - __builtin_popcount(gt);
+            if (gt) return count;  // Keys are sorted, nothing further can match
+        }
+#elif defined(PRQUEUE_SIMD_SSE2)
+        const __m128i needle = _mm_set1_epi32(priority);
+        for (; i + 4 <= n; i += 4) {
+            __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i));
+            int gt = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(block, needle)));
+            count += 4 - __builtin_popcount(gt);
+            if (gt) return count;
+        }
+#endif
+        // Scalar tail (or the whole node when SIMD is unavailable)
+        for (; i < n && keys[i] <= priority; i++) {
+            count++;
+        }
+        return count;
+    }
+
+    LEAF* _newLeaf() {
+        LEAF* leaf = new LEAF;
+        leaf->isLeaf = true;
+        leaf->n = 0;
+        leaf->next = nullptr;
+        return leaf;
+    }
+
+    INNER* _newInner() {
+        INNER* inner = new INNER;
+        inner->isLeaf = false;
+        inner->n = 0;
+        return inner;
+    }
+
+    // Recursive helper function for inserting a value. If `node` had to
+    // split, returns the new right sibling and sets `splitKey` to its
+    // separator; otherwise returns nullptr.
+    BNODE* _insert(BNODE* node, T& value, int priority, int& splitKey) {
+        if (node->isLeaf) {
+            LEAF* leaf = static_cast<LEAF*>(node);
+            LEAF* target = leaf;
+            LEAF* sibling = nullptr;
+
+            if (leaf->n == WIDTH) {
+                // Move the upper half into a new leaf, chained after this one
+                sibling = _newLeaf();
+                int half = WIDTH / 2;
+                for (int i = half; i < WIDTH; i++) {
+                    sibling->keys[i - half] = leaf->keys[i];
+                    sibling->values[i - half] = std::move(leaf->values[i]);
+                }
+                sibling->n = WIDTH - half;
+                leaf->n = half;
+                sibling->next = leaf->next;
+                leaf->next = sibling;
+                splitKey = sibling->keys[0];
+
+                if (priority >= splitKey) target = sibling;
+            }
+
+            // Inserting after every equal key keeps duplicates FIFO
+            int pos = _upperBound(target->keys, target->n, priority);
+            for (int i = target->n; i > pos; i--) {
+                target->keys[i] = target->keys[i - 1];
+                target->values[i] = std::move(target->values[i - 1]);
+            }
+            target->keys[pos] = priority;
+            target->values[pos] = std::move(value);
+            target->n++;
+            return sibling;
+        }
+
+        INNER* inner = static_cast<INNER*>(node);
+        int idx = _upperBound(inner->keys, inner->n - 1, priority);
+        int childKey;
+        BNODE* newChild = _insert(inner->children[idx], value, priority, childKey);
+        if (!newChild) return nullptr;
+
+        // Make room for the new child right after the one that split
+        for (int i = inner->n; i > idx + 1; i--) {
+            inner->children[i] = inner->children[i - 1];
+            inner->keys[i - 1] = inner->keys[i - 2];
+        }
+        inner->children[idx + 1] = newChild;
+        inner->keys[idx] = childKey;
+        inner->n++;
+
+        if (inner->n < WIDTH) return nullptr;
+
+        // Full: move the upper half of the children into a new inner node,
+        // pushing the middle separator up to the parent
+        INNER* sibling = _newInner();
+        int half = WIDTH / 2;
+        for (int i = half; i < WIDTH; i++) {
+            sibling->children[i - half] = inner->children[i];
+        }
+        for (int i = half; i < WIDTH - 1; i++) {
+            sibling->keys[i - half] = inner->keys[i];
+        }
+        sibling->n = WIDTH - half;
+        splitKey = inner->keys[half - 1];
+        inner->n = half;
+        return sibling;
+    }
+
+    // Removes the emptied leftmost leaf from the tree. Inner nodes left with
+    // no children are removed as well, and the root is collapsed while it
+    // only has a single child.
+    bool _removeFirstLeaf(BNODE* node) {
+        if (node->isLeaf) {
+            delete static_cast<LEAF*>(node);
+            return true;
+        }
+
+        INNER* inner = static_cast<INNER*>(node);
+        if (!_removeFirstLeaf(inner->children[0])) return false;
+
+        for (int i = 1; i < inner->n; i++) {
+            inner->children[i - 1] = inner->children[i];
+        }
+        for (int i = 1; i < inner->n - 1; i++) {
+            inner->keys[i - 1] = inner->keys[i];
+        }
+        inner->n--;
+
+        if (inner->n > 0) return false;
+        delete inner;
+        return true;
+    }
+
+    // Clones a given tree, appending the cloned leaves to the chain ending
+    // at `tail`. Used in copy constructor and assignment operator.
+    BNODE* _clone(const BNODE* node, LEAF*& tail) {
+        if (node->isLeaf) {
+            const LEAF* leaf = static_cast<const LEAF*>(node);
+            LEAF* newLeaf = _newLeaf();
+            newLeaf->n = leaf->n;
+            for (int i = 0; i < leaf->n; i++) {
+                newLeaf->keys[i] = leaf->keys[i];
+                newLeaf->values[i] = leaf->values[i];
+            }
+            if (tail) {
+                tail->next = newLeaf;
+            } else {
+                head = newLeaf;
+            }
+            tail = newLeaf;
+            return newLeaf;
+        }
+
+        const INNER* inner = static_cast<const INNER*>(node);
+        INNER* newInner = _newInner();
+        newInner->n = inner->n;
+        for (int i = 0; i < inner->n - 1; i++) {
+            newInner->keys[i] = inner->keys[i];
+        }
+        for (int i = 0; i < inner->n; i++) {
+            newInner->children[i] = _clone(inner->children[i], tail);
+        }
+        return newInner;
+    }
+
+    // Recursively clears the memory used by the tree
+    void _clear(BNODE* node) {
+        if (!node) return;
+
+        if (node->isLeaf) {
+            delete static_cast<LEAF*>(node);
+            return;
+        }
+
+        INNER* inner = static_cast<INNER*>(node);
+        for (int i = 0; i < inner->n; i++) {
+            _clear(inner->children[i]);
+        }
+        delete inner;
+    }
+
+    // Compares two trees for equality in structure, values, and priorities
+    bool _areEqual(const BNODE* a, const BNODE* b) const {
+        if (!a && !b) return true;
+        if (!a || !b) return false;
+        if (a->isLeaf != b->isLeaf || a->n != b->n) return false;
+
+        if (a->isLeaf) {
+            const LEAF* la = static_cast<const LEAF*>(a);
+            const LEAF* lb = static_cast<const LEAF*>(b);
+            for (int i = 0; i < a->n; i++) {
+                if (la->keys[i] != lb->keys[i] || la->values[i] != lb->values[i])
+                    return false;
+            }
+            return true;
+        }
+
+        const INNER* ia = static_cast<const INNER*>(a);
+        const INNER* ib = static_cast<const INNER*>(b);
+        for (int i = 0; i < a->n - 1; i++) {
+            if (ia->keys[i] != ib->keys[i]) return false;
+        }
+        for (int i = 0; i < a->n; i++) {
+            if (!_areEqual(ia->children[i], ib->children[i])) return false;
+        }
+        return true;
+    }
+
+   public:
+    /// Creates an empty `bpprqueue`.
+    ///
+    /// Runs in O(1).
+    bpprqueue() {
+        root = nullptr;
+        head = nullptr;
+        sz = 0;
+        curr = nullptr;
+        currIdx = 0;
+    }
+
+    /// Copy constructor.
+    ///
+    /// Copies the value-priority pairs from the provided `bpprqueue`.
+    /// The internal tree structure is copied exactly.
+    ///
+    /// Runs in O(N), where N is the number of values in `other`.
+    bpprqueue(const bpprqueue& other) {
+        root = nullptr;
+        head = nullptr;
+        sz = other.sz;
+        curr = nullptr;
+        currIdx = 0;
+
+        if (other.root != nullptr) {
+            LEAF* tail = nullptr;
+            root = _clone(other.root, tail);
+        }
+    }
+
+    /// Assignment operator; `operator=`.
+    ///
+    /// Clears `this` tree, and copies the value-priority pairs from the
+    /// provided `bpprqueue`. The internal tree structure is copied exactly.
+    ///
+    /// Runs in O(N + O), where N is the number of values in `this`, and O is
+    /// the number of values in `other`.
+    bpprqueue& operator=(const bpprqueue& other) {
+        if (this != &other) {  // Handle self-assignment
+            clear();
+            if (other.root != nullptr) {
+                LEAF* tail = nullptr;
+                root = _clone(other.root, tail);
+            }
+            sz = other.sz;
+        }
+        return *this;
+    }
+
+    /// Empties the `bpprqueue`, freeing all memory it controls.
+    ///
+    /// Runs in O(N), where N is the number of values.
+    void clear() {
+        _clear(root);
+        root = nullptr;
+        head = nullptr;
+        sz = 0;
+        curr = nullptr;
+        currIdx = 0;
+    }
+
+    /// Destructor, cleans up all memory associated with `bpprqueue`.
+    ///
+    /// Runs in O(N), where N is the number of values.
+    ~bpprqueue() {
+        clear();
+    }
+
+    /// Adds `value` to the `bpprqueue` with the given `priority`.
+    ///
+    /// Runs in O(W log_W N), where W is the node width.
+    void enqueue(T value, int priority) {
+        if (!root) {
+            head = _newLeaf();
+            root = head;
+        }
+
+        int splitKey;
+        BNODE* sibling = _insert(root, value, priority, splitKey);
+        if (sibling) {
+            // The root split, so the tree grows by one level
+            INNER* newRoot = _newInner();
+            newRoot->children[0] = root;
+            newRoot->children[1] = sibling;
+            newRoot->keys[0] = splitKey;
+            newRoot->n = 2;
+            root = newRoot;
+        }
+        sz++;
+    }
+
+    /// Returns the value with the smallest priority in the `bpprqueue`, but
+    /// does not modify the `bpprqueue`.
+    ///
+    /// If the `bpprqueue` is empty, returns the default value for `T`.
+    ///
+    /// Runs in O(1).
+    T peek() const {
+        if (!head) {
+            return T{};
+        }
+        return head->values[0];
+    }
+
+    /// Returns the value with the smallest priority in the `bpprqueue` and
+    /// removes it from the `bpprqueue`.
+    ///
+    /// If the `bpprqueue` is empty, returns the default value for `T`.
+    ///
+    /// Runs in O(W) amortized, where W is the node width.
+    T dequeue() {
+        if (!head) {
+            return T{};
+        }
+
+        T returnValue = std::move(head->values[0]);
+        for (int i = 1; i < head->n; i++) {
+            head->keys[i - 1] = head->keys[i];
+            head->values[i - 1] = std::move(head->values[i]);
+        }
+        head->n--;
+
+        if (head->n == 0) {
+            LEAF* next = head->next;
+            if (_removeFirstLeaf(root)) {
+                root = nullptr;  // That was the last leaf
+            } else {
+                // Collapse inner roots that are left with a single child
+                while (!root->isLeaf && root->n == 1) {
+                    INNER* old = static_cast<INNER*>(root);
+                    root = old->children[0];
+                    delete old;
+                }
+            }
+            head = next;
+        }
+
+        sz--;
+        return returnValue;
+    }
+
+    /// Returns the number of elements in the `bpprqueue`.
+    ///
+    /// Runs in O(1).
+    size_t size() const {
+        return sz;
+    }
+
+    /// Resets internal state for an in-order traversal of the leaf chain.
+    ///
+    /// See `next` for usage details.
+    ///
+    /// Runs in O(1).
+    void begin() {
+        curr = head;
+        currIdx = 0;
+    }
+
+    /// Uses the internal state to return the next in-order value and priority
+    /// by reference, and advances the internal state. Returns true if the
+    /// reference parameters were set, and false otherwise.
+    ///
+    /// Runs in O(1).
+    bool next(T& value, int& priority) {
+        if (curr && currIdx == curr->n) {
+            curr = curr->next;
+            currIdx = 0;
+        }
+        if (!curr) {
+            return false;
+        }
+
+        value = curr->values[currIdx];
+        priority = curr->keys[currIdx];
+        currIdx++;
+        return true;
+    }
+
+    /// Converts the `bpprqueue` to a string representation, with the values
+    /// in-order by priority. Uses the same format as `prqueue::as_string`.
+    ///
+    /// Runs in O(N), where N is the number of values.
+    string as_string() const {
+        ostringstream oss;
+        for (const LEAF* leaf = head; leaf != nullptr; leaf = leaf->next) {
+            for (int i = 0; i < leaf->n; i++) {
+                oss << leaf->keys[i] << " value: " << leaf->values[i] << endl;
+            }
+        }
+        return oss.str();
+    }
+
+    /// Checks if the contents of `this` and `other` are equivalent.
+    ///
+    /// Two `bpprqueue`s are equivalent if they have the same priorities and
+    /// values, as well as the same internal node layout.
+    ///
+    /// Runs in O(N) time, where N is the maximum number of values in
+    /// either `bpprqueue`.
+    bool operator==(const bpprqueue& other) const {
+        return _areEqual(root, other.root);
+    }
+
+    /// Returns a pointer to the root node of the B+-tree.
+    ///
+    /// Used for testing the internal structure of the tree.
+    ///
+    /// Runs in O(1).
+    void* getRoot() {
+        return root;
+    }
+};
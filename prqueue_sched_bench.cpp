@@ -0,0 +1,82 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "prqueue_scheduler.h"
+
+using namespace std;
+
+// Stands in for a task body: `work` rounds of an LCG the compiler can't skip.
+static unsigned spin(unsigned seed, int work) {
+    for (int i = 0; i < work; i++) {
+        seed = seed * 1664525u + 1013904223u;
+    }
+    return seed;
+}
+
+// Runs `tasks` tasks on `workers` threads. The load is skewed: every task
+// starts on worker 0, so the others only get work by stealing. Returns the
+// wall-clock time in milliseconds.
+static double run(size_t workers, int tasks, int work, bool report) {
+    prscheduler<int> sched(workers);
+    for (int i = 0; i < tasks; i++) {
+        sched.push(0, i, i % 1024);
+    }
+
+    atomic<int> remaining(tasks);
+    atomic<unsigned> checksum(0);
+    auto t0 = chrono::steady_clock::now();
+
+    vector<thread> threads;
+    for (size_t w = 0; w < workers; w++) {
+        threads.emplace_back([&, w]() {
+            unsigned local = 0;
+            int value, priority;
+            while (remaining.load(memory_order_relaxed) > 0) {
+                if (sched.pop(w, value, priority)) {
+                    local += spin(value, work);
+                    remaining.fetch_sub(1, memory_order_relaxed);
+                } else {
+                    this_thread::yield();
+                }
+            }
+            checksum.fetch_add(local);
+        });
+    }
+    for (thread& t : threads) {
+        t.join();
+    }
+
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+    if (report) {
+        for (size_t w = 0; w < workers; w++) {
+            prscheduler<int>::worker_stats stats = sched.get_stats(w);
+            cout << "    worker " << w << ": pops " << stats.pops << ", steals " << stats.steals
+                 << ", stolen " << stats.stolenValues << ", failed steals " << stats.failedSteals << endl;
+        }
+    }
+    return ms;
+}
+
+int main(int argc, char** argv) {
+    int tasks = argc > 1 ? atoi(argv[1]) : 200000;
+    int work = argc > 2 ? atoi(argv[2]) : 2000;
+    size_t cores = thread::hardware_concurrency();
+    if (cores == 0) cores = 1;
+
+    cout << tasks << " tasks of " << work << " rounds, all pushed to worker 0, "
+         << cores << " hardware threads" << endl;
+
+    double base = 0;
+    for (size_t workers = 1; workers <= 2 * cores && workers <= 64; workers *= 2) {
+        double ms = run(workers, tasks, work, false);
+        if (workers == 1) base = ms;
+        cout << "  " << workers << " workers: " << ms << " ms, speedup " << base / ms << "x" << endl;
+    }
+
+    cout << "  per-worker metrics with " << cores << " workers:" << endl;
+    run(cores, tasks, work, true);
+}
@@ -0,0 +1,204 @@
+#pragma once
+
+#include <atomic>   // For lock-free depth and stats counters
+#include <memory>   // For unique_ptr
+#include <mutex>    // For the per-shard locks
+#include <utility>  // For pair
+#include <vector>   // For the shards and stolen batches
+
+#include "prqueue.h"
+
+using namespace std;
+
+/// A task scheduler that gives every worker its own `prqueue` shard.
+///
+/// A worker pushes and pops on its own shard, whose lock is uncontended
+/// unless another worker is stealing from it at that moment. When a worker's
+/// shard runs dry, `pop` steals the highest-priority half of the deepest
+/// other shard in one batch. Thieves only `try_lock` their victims, so a
+/// busy shard is skipped instead of waited on.
+///
+/// Queue depths are published through atomics, so victim selection and the
+/// metrics never take a lock.
+template <typename T>
+class prscheduler {
+   public:
+    /// Per-worker counters. See `get_stats`.
+    struct worker_stats {
+        size_t depth;         // Values currently in the worker's shard
+        size_t pushes;        // Values pushed by the worker itself
+        size_t pops;          // Values popped by the worker, stolen or not
+        size_t steals;        // Successful steals by the worker
+        size_t stolenValues;  // Values taken from other shards
+        size_t failedSteals;  // Steal attempts that found nothing to take
+    };
+
+   private:
+    // Padded to a cache line so neighbouring shards' counters don't share one
+    struct alignas(64) SHARD {
+        mutex lock;
+        prqueue<T> queue;
+        atomic<size_t> depth{0};
+        atomic<size_t> pushes{0};
+        atomic<size_t> pops{0};
+        atomic<size_t> steals{0};
+        atomic<size_t> stolenValues{0};
+        atomic<size_t> failedSteals{0};
+    };
+
+    vector<unique_ptr<SHARD>> shards;
+
+    // Moves the highest-priority half of `victim` into `batch`. Returns false
+    // if the victim is busy or empty.
+    bool _takeHalf(SHARD& victim, vector<pair<int, T>>& batch) {
+        unique_lock<mutex> guard(victim.lock, try_to_lock);
+        if (!guard.owns_lock()) return false;
+
+        victim.queue.take_front((victim.queue.size() + 1) / 2, batch);
+        victim.depth.store(victim.queue.size(), memory_order_relaxed);
+        return !batch.empty();
+    }
+
+    // Steals a batch for `thief`, trying the deepest shards first, and
+    // returns the highest-priority stolen value by reference. The rest of the
+    // batch is pushed onto the thief's own shard.
+    bool _steal(size_t thief, T& value, int& priority) {
+        SHARD& own = *shards[thief];
+        vector<pair<int, T>> batch;
+
+        // Depths may be stale by the time we lock; that only costs a retry
+        vector<bool> tried(shards.size(), false);
+        tried[thief] = true;
+        for (size_t attempt = 1; attempt < shards.size() && batch.empty(); attempt++) {
+            size_t victim = thief;
+            size_t deepest = 0;
+            for (size_t i = 0; i < shards.size(); i++) {
+                size_t depth = shards[i]->depth.load(memory_order_relaxed);
+                if (!tried[i] && depth > deepest) {
+                    victim = i;
+                    deepest = depth;
+                }
+            }
+            if (victim == thief) break;  // Every other shard looks empty
+
+            tried[victim] = true;
+            _takeHalf(*shards[victim], batch);
+        }
+
+        if (batch.empty()) {
+            own.failedSteals.fetch_add(1, memory_order_relaxed);
+            return false;
+        }
+
+        own.steals.fetch_add(1, memory_order_relaxed);
+        own.stolenValues.fetch_add(batch.size(), memory_order_relaxed);
+
+        // The batch comes out sorted; enqueue_batch inserts it median-first
+        priority = batch[0].first;
+        value = std::move(batch[0].second);
+        batch.erase(batch.begin());
+        if (!batch.empty()) {
+            lock_guard<mutex> guard(own.lock);
+            own.queue.enqueue_batch(batch);
+            own.depth.store(own.queue.size(), memory_order_relaxed);
+        }
+        return true;
+    }
+
+   public:
+    /// Creates a scheduler with `workers` empty shards.
+    ///
+    /// Runs in O(W), where W is the number of workers.
+    explicit prscheduler(size_t workers) {
+        for (size_t i = 0; i < workers; i++) {
+            shards.push_back(make_unique<SHARD>());
+        }
+    }
+
+    prscheduler(const prscheduler&) = delete;
+    prscheduler& operator=(const prscheduler&) = delete;
+
+    /// Returns the number of workers.
+    ///
+    /// Runs in O(1).
+    size_t workers() const {
+        return shards.size();
+    }
+
+    /// Adds `value` with the given `priority` to the shard of `worker`.
+    ///
+    /// Runs in O(H + M) on the worker's shard, see `prqueue::enqueue`.
+    void push(size_t worker, T value, int priority) {
+        SHARD& own = *shards[worker];
+        lock_guard<mutex> guard(own.lock);
+        own.queue.enqueue(std::move(value), priority);
+        own.depth.store(own.queue.size(), memory_order_relaxed);
+        own.pushes.fetch_add(1, memory_order_relaxed);
+    }
+
+    /// Removes the value with the smallest priority from the shard of
+    /// `worker` and returns it and its priority by reference. If the shard is
+    /// empty, steals the highest-priority half of the deepest other shard
+    /// first. Returns false if no value could be found.
+    ///
+    /// A false return does not mean that every shard is empty: victims that
+    /// are locked by another worker are skipped, and values in the middle of
+    /// being stolen are not visible. Callers that need to drain everything
+    /// should keep track of outstanding work themselves and retry.
+    ///
+    /// Popping from a non-empty shard runs in O(H + M). A steal of K values
+    /// holds the victim's lock for O(H + K), and additionally runs in
+    /// O(W + K log K + K (H + M)), where W is the number of workers.
+    bool pop(size_t worker, T& value, int& priority) {
+        SHARD& own = *shards[worker];
+        bool found;
+        {
+            lock_guard<mutex> guard(own.lock);
+            found = own.queue.dequeue(value, priority);
+            own.depth.store(own.queue.size(), memory_order_relaxed);
+        }
+
+        if (!found) {
+            found = _steal(worker, value, priority);
+        }
+        if (found) {
+            own.pops.fetch_add(1, memory_order_relaxed);
+        }
+        return found;
+    }
+
+    /// Returns the number of values in the shard of `worker`, without
+    /// locking it. The result may be stale while other workers are running.
+    ///
+    /// Runs in O(1).
+    size_t depth(size_t worker) const {
+        return shards[worker]->depth.load(memory_order_relaxed);
+    }
+
+    /// Returns the total number of values across all shards, without
+    /// locking them. Values in the middle of being stolen are not counted.
+    ///
+    /// Runs in O(W), where W is the number of workers.
+    size_t size() const {
+        size_t total = 0;
+        for (const auto& shard : shards) {
+            total += shard->depth.load(memory_order_relaxed);
+        }
+        return total;
+    }
+
+    /// Returns the queue depth and activity counters of `worker`.
+    ///
+    /// Runs in O(1).
+    worker_stats get_stats(size_t worker) const {
+        const SHARD& shard = *shards[worker];
+        return worker_stats{
+            shard.depth.load(memory_order_relaxed),
+            shard.pushes.load(memory_order_relaxed),
+            shard.pops.load(memory_order_relaxed),
+            shard.steals.load(memory_order_relaxed),
+            shard.stolenValues.load(memory_order_relaxed),
+            shard.failedSteals.load(memory_order_relaxed),
+        };
+    }
+};
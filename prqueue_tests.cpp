@@ -1,4 +1,11 @@
 #include "prqueue.h"
+#include "prqueue_bptree.h"
+#include "prqueue_scheduler.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <unordered_set>
 
 #include "gtest/gtest.h"
 
@@ -220,3 +227,519 @@ TEST(PrQueueTests, ComplexTreeInOrderTraversal) {
     EXPECT_EQ(traversal, "10 20 30 50 60 70 80 ");
 }
 
+
+TEST(PrQueueTests, PartialTraversalLeavesTreeIntact) {
+    prqueue<int> pq;
+    pq.enqueue(20, 2);
+    pq.enqueue(10, 1);
+    pq.enqueue(30, 3);
+    pq.begin();
+    int value, priority;
+    EXPECT_TRUE(pq.next(value, priority));
+
+    prqueue<int> expected;
+    expected.enqueue(20, 2);
+    expected.enqueue(10, 1);
+    expected.enqueue(30, 3);
+    EXPECT_TRUE(pq == expected);
+    EXPECT_EQ("1 value: 10\n2 value: 20\n3 value: 30\n", pq.as_string());
+}
+
+TEST(PrQueueTests, BufferedEnqueueDefersUntilPeek) {
+    prqueue<int> pq;
+    pq.set_buffer_threshold(100);
+    pq.enqueue(30, 3);
+    pq.enqueue(10, 1);
+    pq.enqueue(20, 2);
+    EXPECT_EQ(3, pq.size());
+    EXPECT_EQ(0, pq.get_merge_stats().merges);
+
+    EXPECT_EQ(10, pq.peek());
+    EXPECT_EQ(1, pq.get_merge_stats().merges);
+    EXPECT_EQ(3, pq.get_merge_stats().mergedValues);
+    EXPECT_EQ(10, pq.dequeue());
+    EXPECT_EQ(20, pq.dequeue());
+    EXPECT_EQ(30, pq.dequeue());
+    EXPECT_EQ(1, pq.get_merge_stats().merges);
+}
+
+TEST(PrQueueTests, BufferedDuplicatesStayFifo) {
+    prqueue<string> pq;
+    pq.enqueue("A", 2);
+    pq.set_buffer_threshold(4);
+    pq.enqueue("B", 2);
+    pq.enqueue("C", 1);
+    pq.enqueue("D", 2);
+    pq.enqueue("E", 2);  // Fills the buffer
+    EXPECT_EQ(1, pq.get_merge_stats().thresholdMerges);
+    pq.enqueue("F", 2);
+
+    EXPECT_EQ("1 value: C\n2 value: A\n2 value: B\n2 value: D\n2 value: E\n2 value: F\n", pq.as_string());
+    EXPECT_EQ(2, pq.get_merge_stats().merges);
+    EXPECT_EQ(1, pq.get_merge_stats().thresholdMerges);
+}
+
+TEST(PrQueueTests, BufferedSortedBurstStaysBalanced) {
+    prqueue<int> pq;
+    pq.set_buffer_threshold(7);
+    for (int i = 1; i <= 7; i++) {
+        pq.enqueue(i * 10, i);
+    }
+    prqueue<int> balanced;
+    for (int priority : {4, 2, 6, 1, 3, 5, 7}) {
+        balanced.enqueue(priority * 10, priority);
+    }
+    EXPECT_TRUE(pq == balanced);
+}
+
+TEST(PrQueueTests, BufferedCopyAndClear) {
+    prqueue<int> pq;
+    pq.set_buffer_threshold(10);
+    pq.enqueue(20, 2);
+    pq.enqueue(10, 1);
+
+    prqueue<int> pqCopy = pq;
+    EXPECT_EQ(2, pqCopy.size());
+    EXPECT_EQ(10, pqCopy.dequeue());
+
+    pq.enqueue(30, 3);
+    pq.clear();
+    EXPECT_EQ(0, pq.size());
+    EXPECT_EQ(int(), pq.peek());
+
+    pq.enqueue(40, 4);
+    pq.set_buffer_threshold(0);
+    EXPECT_EQ(2, pq.get_merge_stats().merges);
+    EXPECT_EQ(40, pq.dequeue());
+}
+
+TEST(PrQueueTests, AssignmentCopiesBufferThreshold) {
+    prqueue<int> source;
+    source.set_buffer_threshold(10);
+
+    prqueue<int> assigned;
+    assigned = source;
+    assigned.enqueue(10, 1);
+    EXPECT_EQ(0, assigned.get_merge_stats().merges);
+
+    prqueue<int> constructed(source);
+    constructed.enqueue(10, 1);
+    EXPECT_EQ(0, constructed.get_merge_stats().merges);
+
+    assigned = prqueue<int>();
+    assigned.enqueue(10, 1);
+    assigned.peek();
+    EXPECT_EQ(0, assigned.get_merge_stats().merges);
+}
+
+TEST(PrQueueTests, TakeFront) {
+    prqueue<string> pq;
+    pq.enable_fingerprint();
+    pq.enqueue("D", 4);
+    pq.enqueue("B", 2);
+    pq.enqueue("C", 2);
+    pq.enqueue("A", 1);
+    pq.enqueue("E", 5);
+
+    vector<pair<int, string>> front;
+    EXPECT_EQ(3, pq.take_front(3, front));
+    ASSERT_EQ(3, front.size());
+    EXPECT_EQ(make_pair(1, string("A")), front[0]);
+    EXPECT_EQ(make_pair(2, string("B")), front[1]);
+    EXPECT_EQ(make_pair(2, string("C")), front[2]);
+    EXPECT_EQ(2, pq.size());
+    EXPECT_EQ("4 value: D\n5 value: E\n", pq.as_string());
+
+    prqueue<string> expected;
+    expected.enqueue("D", 4);
+    expected.enqueue("E", 5);
+    EXPECT_EQ(expected.fingerprint(), pq.fingerprint());
+    EXPECT_TRUE(pq == expected);
+
+    EXPECT_EQ(2, pq.take_front(10, front));
+    EXPECT_EQ(0, pq.size());
+    EXPECT_EQ(nullptr, pq.getRoot());
+}
+
+TEST(PrQueueTests, EnqueueBatchInsertsMedianFirst) {
+    prqueue<int> pq;
+    vector<pair<int, int>> batch;
+    for (int i = 1; i <= 7; i++) {
+        batch.emplace_back(i, i * 10);
+    }
+    batch.emplace_back(4, 41);
+    pq.enqueue_batch(batch);
+    EXPECT_EQ(8, pq.size());
+
+    prqueue<int> balanced;
+    for (int priority : {4, 2, 6, 1, 3, 5, 7}) {
+        balanced.enqueue(priority * 10, priority);
+    }
+    balanced.enqueue(41, 4);
+    EXPECT_TRUE(pq == balanced);
+}
+
+TEST(PrQueueTests, FingerprintTracksEquivalentTrees) {
+    prqueue<string> a;
+    a.enable_fingerprint();
+    a.enqueue("2", 2);
+    a.enqueue("1", 1);
+    a.enqueue("3", 3);
+
+    prqueue<string> b;
+    b.enqueue("2", 2);
+    b.enqueue("3", 3);
+    b.enqueue("1", 1);
+    EXPECT_EQ(a.fingerprint(), b.fingerprint());
+    EXPECT_TRUE(a == b);
+
+    prqueue<string> c;
+    c.enqueue("1", 1);
+    c.enqueue("2", 2);
+    c.enqueue("3", 3);
+    EXPECT_NE(a.fingerprint(), c.fingerprint());
+    EXPECT_FALSE(a == c);
+
+    prqueue<string> d = a;
+    EXPECT_EQ(a.fingerprint(), d.fingerprint());
+    d.clear();
+    EXPECT_EQ(prqueue<string>().fingerprint(), d.fingerprint());
+}
+
+TEST(PrQueueTests, FingerprintAfterDequeue) {
+    // Dequeueing 1 re-parents 3 under 5, and the duplicate list of 7 shifts.
+    // Only the left-hand queues maintain their fingerprints incrementally.
+    prqueue<int> a;
+    a.enable_fingerprint();
+    for (int priority : {5, 1, 3, 2, 4, 7}) {
+        a.enqueue(priority * 10, priority);
+    }
+    a.enqueue(71, 7);
+    a.enqueue(72, 7);
+    a.dequeue();
+
+    prqueue<int> b;
+    for (int priority : {5, 3, 2, 4, 7}) {
+        b.enqueue(priority * 10, priority);
+    }
+    b.enqueue(71, 7);
+    b.enqueue(72, 7);
+    EXPECT_EQ(a.fingerprint(), b.fingerprint());
+    EXPECT_TRUE(a == b);
+
+    // Draining the duplicates of a root keeps the fingerprint in sync
+    prqueue<int> c;
+    c.enable_fingerprint();
+    c.enqueue(1, 7);
+    c.enqueue(2, 7);
+    c.enqueue(3, 7);
+    c.dequeue();
+    prqueue<int> e;
+    e.enqueue(2, 7);
+    e.enqueue(3, 7);
+    EXPECT_EQ(c.fingerprint(), e.fingerprint());
+    EXPECT_TRUE(c == e);
+
+    c.dequeue();
+    c.dequeue();
+    EXPECT_EQ(prqueue<int>().fingerprint(), c.fingerprint());
+}
+
+TEST(PrQueueTests, FingerprintEnabledLate) {
+    prqueue<int> a;
+    a.enqueue(20, 2);
+    a.enqueue(10, 1);
+    a.enqueue(11, 1);
+    size_t computed = a.fingerprint();
+    a.enable_fingerprint();
+    EXPECT_EQ(computed, a.fingerprint());
+
+    prqueue<int> b = a;
+    a.dequeue();
+    b.dequeue();
+    b.enqueue(30, 3);
+    a.enqueue(30, 3);
+    EXPECT_EQ(a.fingerprint(), b.fingerprint());
+    EXPECT_TRUE(a == b);
+}
+
+TEST(PrQueueTests, FingerprintMatchesRecomputation) {
+    // Each tracked queue gets the same operations as a plain one, whose
+    // fingerprint is recomputed from scratch on every call
+    prqueue<int> tracked, plain, trackedBuffered, plainBuffered;
+    tracked.enable_fingerprint();
+    trackedBuffered.enable_fingerprint();
+    trackedBuffered.set_buffer_threshold(16);
+    plainBuffered.set_buffer_threshold(16);
+    prqueue<int>* queues[] = {&tracked, &plain, &trackedBuffered, &plainBuffered};
+
+    unsigned seed = 251;
+    for (int i = 0; i < 2000; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        int priority = (seed >> 8) % 64;
+        bool dequeue = (seed >> 20) % 3 == 0;
+        for (prqueue<int>* q : queues) {
+            if (dequeue) {
+                q->dequeue();
+            } else {
+                q->enqueue(i, priority);
+            }
+        }
+
+        if (i % 50 == 0) {
+            EXPECT_EQ(plain.fingerprint(), tracked.fingerprint());
+            EXPECT_EQ(plainBuffered.fingerprint(), trackedBuffered.fingerprint());
+            EXPECT_TRUE(tracked == plain);
+        }
+    }
+}
+
+TEST(PrQueueTests, FingerprintDrainsDuplicatesInLinearTime) {
+    // Buffered enqueues append each run of duplicates in a single walk
+    prqueue<int> pq;
+    pq.enable_fingerprint();
+    pq.set_buffer_threshold(1 << 20);
+    for (int i = 0; i < 200000; i++) {
+        pq.enqueue(i, i < 100000 ? 1 : 2);
+    }
+    for (int i = 0; i < 100000; i++) {
+        pq.dequeue();
+    }
+    prqueue<int> expected;
+    expected.set_buffer_threshold(1 << 20);
+    for (int i = 100000; i < 200000; i++) {
+        expected.enqueue(i, 2);
+    }
+    EXPECT_EQ(expected.fingerprint(), pq.fingerprint());
+}
+
+TEST(PrQueueTests, FingerprintSeesValues) {
+    prqueue<int> a;
+    a.enqueue(10, 1);
+    prqueue<int> b;
+    b.enqueue(11, 1);
+    EXPECT_NE(a.fingerprint(), b.fingerprint());
+    EXPECT_FALSE(a == b);
+}
+
+TEST(PrQueueTests, HashKeysUnorderedSet) {
+    prqueue<int> a;
+    a.enqueue(20, 2);
+    a.enqueue(10, 1);
+    prqueue<int> b;
+    b.set_buffer_threshold(10);
+    b.enqueue(20, 2);
+    b.enqueue(10, 1);
+    prqueue<int> c;
+    c.enqueue(10, 1);
+
+    unordered_set<prqueue<int>> seen;
+    seen.insert(a);
+    seen.insert(b);
+    seen.insert(c);
+    EXPECT_EQ(2, seen.size());
+    EXPECT_EQ(1, seen.count(b));
+}
+
+TEST(BpPrQueueTests, EnqueuePeekDequeue) {
+    bpprqueue<int> pq;
+    pq.enqueue(30, 3);
+    pq.enqueue(10, 1);
+    pq.enqueue(20, 2);
+    EXPECT_EQ(3, pq.size());
+    EXPECT_EQ(10, pq.peek());
+    EXPECT_EQ(10, pq.dequeue());
+    EXPECT_EQ(20, pq.dequeue());
+    EXPECT_EQ(30, pq.dequeue());
+    EXPECT_EQ(0, pq.size());
+    EXPECT_EQ(int(), pq.dequeue());
+}
+
+TEST(BpPrQueueTests, ManySplitsDrainInOrder) {
+    // Narrow nodes force several levels of splits
+    bpprqueue<int, 4> pq;
+    for (int i = 0; i < 1000; i++) {
+        int priority = (i * 7919) % 1000;
+        pq.enqueue(priority * 10, priority);
+    }
+    EXPECT_EQ(1000, pq.size());
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_EQ(i * 10, pq.dequeue());
+    }
+    EXPECT_EQ(0, pq.size());
+    EXPECT_EQ(nullptr, pq.getRoot());
+}
+
+TEST(BpPrQueueTests, DuplicatesAreFifoAcrossLeaves) {
+    bpprqueue<int, 4> pq;
+    for (int i = 0; i < 50; i++) {
+        pq.enqueue(i, i % 2);
+    }
+    for (int i = 0; i < 50; i += 2) {
+        EXPECT_EQ(i, pq.dequeue());
+    }
+    for (int i = 1; i < 50; i += 2) {
+        EXPECT_EQ(i, pq.dequeue());
+    }
+}
+
+TEST(BpPrQueueTests, IterationAndAsString) {
+    bpprqueue<string, 4> pq;
+    pq.enqueue("Gwen", 3);
+    pq.enqueue("Jen", 2);
+    pq.enqueue("Ben", 1);
+    pq.enqueue("Sven", 2);
+    pq.enqueue("Ken", 0);
+    EXPECT_EQ("0 value: Ken\n1 value: Ben\n2 value: Jen\n2 value: Sven\n3 value: Gwen\n", pq.as_string());
+
+    pq.begin();
+    string value;
+    int priority;
+    string traversal;
+    while (pq.next(value, priority)) {
+        traversal += to_string(priority) + value + " ";
+    }
+    EXPECT_EQ("0Ken 1Ben 2Jen 2Sven 3Gwen ", traversal);
+}
+
+TEST(BpPrQueueTests, CopyAndEquality) {
+    bpprqueue<int, 4> pq;
+    for (int i = 0; i < 100; i++) {
+        pq.enqueue(i, (i * 37) % 100);
+    }
+    bpprqueue<int, 4> pqCopy = pq;
+    EXPECT_TRUE(pq == pqCopy);
+
+    bpprqueue<int, 4> pqAssign;
+    pqAssign.enqueue(1, 1);
+    pqAssign = pq;
+    EXPECT_TRUE(pq == pqAssign);
+
+    pqCopy.dequeue();
+    EXPECT_FALSE(pq == pqCopy);
+    EXPECT_EQ(pq.as_string(), pqAssign.as_string());
+}
+
+TEST(PrSchedulerTests, LocalPushPop) {
+    prscheduler<int> sched(2);
+    sched.push(0, 30, 3);
+    sched.push(0, 10, 1);
+    EXPECT_EQ(2, sched.depth(0));
+
+    int value, priority;
+    EXPECT_TRUE(sched.pop(0, value, priority));
+    EXPECT_EQ(10, value);
+    EXPECT_EQ(1, priority);
+    EXPECT_EQ(1, sched.depth(0));
+    EXPECT_EQ(0, sched.get_stats(0).steals);
+}
+
+TEST(PrSchedulerTests, StealsHighestPriorityHalf) {
+    prscheduler<int> sched(3);
+    for (int i = 9; i >= 0; i--) {
+        sched.push(1, i * 10, i);
+    }
+    sched.push(2, 500, 50);
+
+    // Worker 0 is empty, so it steals priorities 0-4 from the deepest shard
+    int value, priority;
+    EXPECT_TRUE(sched.pop(0, value, priority));
+    EXPECT_EQ(0, value);
+    EXPECT_EQ(0, priority);
+    EXPECT_EQ(4, sched.depth(0));
+    EXPECT_EQ(5, sched.depth(1));
+    EXPECT_EQ(1, sched.depth(2));
+
+    prscheduler<int>::worker_stats stats = sched.get_stats(0);
+    EXPECT_EQ(1, stats.steals);
+    EXPECT_EQ(5, stats.stolenValues);
+    EXPECT_EQ(1, stats.pops);
+
+    EXPECT_TRUE(sched.pop(0, value, priority));
+    EXPECT_EQ(10, value);
+    EXPECT_EQ(1, sched.get_stats(0).steals);
+}
+
+TEST(PrSchedulerTests, PopFailsWhenAllShardsEmpty) {
+    prscheduler<int> sched(2);
+    int value, priority;
+    EXPECT_FALSE(sched.pop(1, value, priority));
+    EXPECT_EQ(1, sched.get_stats(1).failedSteals);
+    EXPECT_EQ(0, sched.size());
+}
+
+TEST(PrSchedulerTests, StealOfSortedBatchStaysFast) {
+    // 120000 distinct priorities, pushed in a scrambled order so the victim's
+    // own tree stays shallow. The stolen half comes out sorted, which used to
+    // turn the thief's tree into a linked list.
+    const int tasks = 120000;
+    prscheduler<int> sched(2);
+    for (int i = 0; i < tasks; i++) {
+        int priority = int((i * 7919LL) % tasks);
+        sched.push(0, priority, priority);
+    }
+
+    auto start = chrono::steady_clock::now();
+    int value, priority;
+    EXPECT_TRUE(sched.pop(1, value, priority));
+    EXPECT_EQ(0, priority);
+    EXPECT_EQ(tasks / 2 - 1, sched.depth(1));
+    for (int i = 1; i < tasks / 2; i++) {
+        EXPECT_TRUE(sched.pop(1, value, priority));
+        EXPECT_EQ(i, priority);
+    }
+    EXPECT_EQ(1, sched.get_stats(1).steals);
+    EXPECT_LT(chrono::steady_clock::now() - start, chrono::seconds(5));
+}
+
+TEST(PrSchedulerTests, ConcurrentDrainOfSkewedLoad) {
+    const int workers = 4;
+    const int tasks = 20000;
+    prscheduler<int> sched(workers);
+    for (int i = 0; i < tasks; i++) {
+        sched.push(0, i, i % 97);
+    }
+
+    // A failed pop may only mean the victim was busy, so workers keep going
+    // until every task has been run. Yielding after each task interleaves
+    // the workers even on a single core.
+    atomic<int> remaining(tasks);
+    atomic<bool> go(false);
+    vector<long long> sums(workers, 0);
+    vector<int> counts(workers, 0);
+    vector<thread> threads;
+    for (int w = 0; w < workers; w++) {
+        threads.emplace_back([&, w]() {
+            while (!go.load()) {
+                this_thread::yield();
+            }
+            int value, priority;
+            while (remaining.load() > 0) {
+                if (sched.pop(w, value, priority)) {
+                    sums[w] += value;
+                    counts[w]++;
+                    remaining.fetch_sub(1);
+                }
+                this_thread::yield();
+            }
+        });
+    }
+    go.store(true);
+    for (thread& t : threads) {
+        t.join();
+    }
+
+    long long sum = 0;
+    int count = 0;
+    size_t steals = 0;
+    for (int w = 0; w < workers; w++) {
+        sum += sums[w];
+        count += counts[w];
+        EXPECT_EQ(counts[w], sched.get_stats(w).pops);
+        if (w > 0) steals += sched.get_stats(w).steals;
+    }
+    EXPECT_EQ(tasks, count);
+    EXPECT_EQ((long long)tasks * (tasks - 1) / 2, sum);
+    EXPECT_EQ(0, sched.size());
+    EXPECT_GT(steals, 0);
+}